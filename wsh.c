@@ -1,3 +1,4 @@
+#define _GNU_SOURCE // tee(2) & splice(2)
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +9,13 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "wshstat.h"
 
 // job code / logic from GNU C Library //
 
@@ -22,6 +30,11 @@ typedef struct Job {
     int isValid;	// 0 if space in use, 1 otherwise
     pid_t pid;		// 
     pid_t pgid;		// 
+    int isStopped;	// if the job was stopped by SIGTSTP
+    time_t startTime;	// when the job was added
+    long cpuUsec;	// user + sys time, set when reaped
+    long maxRSS;	// peak RSS in KB, set when reaped
+    int exitStatus;	// wait status, set when reaped
 } Job;
 
 // GLOBAL VARIABLES //
@@ -33,18 +46,229 @@ int shellTerminal;
 int isShellInteractive;
 volatile sig_atomic_t sigChildFlag = 0;
 volatile sig_atomic_t sigStopFlag = 0;
+int sigChildPipe[2] = {-1, -1}; // SIGCHLD writes a byte here to wake a poll
 int pipeFile;
 int isPipe;
+StatPage *statusPage;	// shared job table for monitoring, NULL if unavailable
+pid_t statusOwner;	// only the shell writes the page, never its children
+char statusPath[512];
+long commandsRun;
+long spawns;
+Job lastReaped;		// most recently finished job
+int hasLastReaped;
+
+
+// ** STATUS PAGE ** //
+
+// `<program name> <arg1> ... <argN>` without snprintf -- safe in the handler
+void statusCommand(Job *job, char cmd[]) {
+    int len = 0;
+    char *part = job->programName;
+    for(int i = -1; i < job->numArgs; i++) {
+        if(i >= 0) {
+            part = job->args[i];
+            if(len < STAT_CMD_LEN - 1) cmd[len++] = ' ';
+        }
+        for(int j = 0; part != NULL && part[j] != '\0' && len < STAT_CMD_LEN - 1; j++)
+            cmd[len++] = part[j];
+    }
+    cmd[len] = '\0';
+}
+
+
+void statusFill(StatJob *out, Job *job, int state) {
+    out->id = job->isFG ? 0 : job->id;
+    out->state = state;
+    out->pid = job->pid;
+    out->pgid = job->pgid;
+    out->startTime = job->startTime;
+    out->cpuUsec = job->cpuUsec;
+    out->maxRSS = job->maxRSS;
+    out->exitStatus = job->exitStatus;
+    statusCommand(job, out->cmd);
+}
+
+
+// the SIGCHLD handler walks allJobs -- hold it off while the list changes
+void blockSigChild(sigset_t *old) {
+    sigset_t block;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &block, old);
+}
+
+
+void restoreSigMask(sigset_t *old) {
+    sigprocmask(SIG_SETMASK, old, NULL);
+}
+
+
+/**
+ * rewrite the status page from the job list
+ * called on every job state change, never on a timer
+ */
+void publishStatus() {
+    if(statusPage == NULL || getpid() != statusOwner) return;
+
+    // the SIGCHLD handler publishes too -- keep it out while the page is odd
+    sigset_t old;
+    blockSigChild(&old);
+
+    uint64_t seq = atomic_load_explicit(&statusPage->seq, memory_order_relaxed);
+    atomic_store_explicit(&statusPage->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    int numJobs = 0;
+    int queueDepth = 0;
+    if(!foregroundJob.isValid && foregroundJob.isFG) {
+        statusFill(&statusPage->jobs[numJobs], &foregroundJob, STAT_FG);
+        numJobs++;
+    }
+    for(int i = 0; i < 256 && numJobs < STAT_MAX_JOBS; i++) {
+        if(allJobs[i].isValid || allJobs[i].isFG) continue;
+
+        int state = STAT_BG;
+        if(allJobs[i].isDone) state = STAT_DONE;
+        else if(allJobs[i].isStopped) state = STAT_STOPPED;
+        if(state != STAT_DONE) queueDepth++;
+
+        statusFill(&statusPage->jobs[numJobs], &allJobs[i], state);
+        numJobs++;
+    }
+    statusPage->numJobs = numJobs;
+    statusPage->queueDepth = queueDepth;
+    statusPage->commandsRun = commandsRun;
+    statusPage->spawns = spawns;
+    if(hasLastReaped) {
+        statusFill(&statusPage->last, &lastReaped, STAT_DONE);
+        statusPage->hasLast = 1;
+    }
+
+    atomic_store_explicit(&statusPage->seq, seq + 2, memory_order_release);
+    restoreSigMask(&old);
+}
+
+
+/**
+ * record a child reported by wait4
+ * a finished child keeps its CPU & RSS in its job and becomes lastReaped
+ */
+void statusReaped(pid_t pid, int status, long cpuUsec, long maxRSS) {
+    if(WIFSTOPPED(status)) {
+        for(int i = 0; i < 256; i++) {
+            if(!allJobs[i].isValid && allJobs[i].pid == pid) allJobs[i].isStopped = 1;
+        }
+        return;
+    }
+
+    Job *job = NULL;
+    for(int i = 0; i < 256; i++) {
+        if(!allJobs[i].isValid && allJobs[i].pid == pid) {
+            job = &allJobs[i];
+            job->isDone = 1;
+        }
+    }
+    if(job == NULL && foregroundJob.pid == pid) job = &foregroundJob;
+    if(job == NULL) return; // not one of ours (e.g. a fan-out consumer)
+
+    job->cpuUsec = cpuUsec;
+    job->maxRSS = maxRSS;
+    job->exitStatus = status;
+    lastReaped = *job;
+    hasLastReaped = 1;
+}
+
+
+// user + sys time of a reaped child in microseconds
+long usageCPU(struct rusage *usage) {
+    return (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * 1000000L
+        + usage->ru_utime.tv_usec + usage->ru_stime.tv_usec;
+}
+
+
+void statusCleanup() {
+    if(statusPage != NULL && getpid() == statusOwner) unlink(statusPath);
+}
+
+
+// SIGHUP (terminal closed) & SIGTERM skip atexit -- drop the page, then
+// die of the same signal
+void sigexit_handler(int sig) {
+    statusCleanup();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+
+/**
+ * create <statDir>/<pid>.stat and map it shared
+ * monitoring is optional -- the shell keeps going without it
+ */
+void statusInit() {
+    char dir[256];
+    statDir(dir, sizeof(dir));
+    if((mkdir(dir, S_IRWXU) < 0 && errno != EEXIST) || statDirIsPrivate(dir) < 0) {
+        char notPrivate[256] = "Status directory is not private, no status page\n";
+        write(STDOUT_FILENO, notPrivate, strlen(notPrivate));
+        return;
+    }
+    snprintf(statusPath, sizeof(statusPath), "%s/%d.stat", dir, (int)getpid());
+
+    // a page left by a dead shell with our pid is stale -- never follow links
+    unlink(statusPath);
+    int fd = open(statusPath, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW, S_IRUSR | S_IWUSR);
+    if(fd == -1 || ftruncate(fd, sizeof(StatPage)) < 0) {
+        char statusFailed[256] = "Failed to create status page\n";
+        write(STDOUT_FILENO, statusFailed, strlen(statusFailed));
+        if(fd != -1) close(fd);
+        return;
+    }
+
+    void *page = mmap(NULL, sizeof(StatPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(page == MAP_FAILED) {
+        char statusFailed[256] = "Failed to map status page\n";
+        write(STDOUT_FILENO, statusFailed, strlen(statusFailed));
+        unlink(statusPath);
+        return;
+    }
+
+    statusPage = page;
+    statusOwner = getpid();
+    statusPage->magic = STAT_MAGIC;
+    statusPage->version = STAT_VERSION;
+    statusPage->shellPid = statusOwner;
+    statusPage->startTime = time(NULL);
+    statusPage->procStart = statProcStart(statusOwner);
+    atexit(statusCleanup);
+    signal(SIGHUP, sigexit_handler);
+    signal(SIGTERM, sigexit_handler);
+    publishStatus();
+}
 
 
 // Handle SIGCHLD (child process dies)
 void sigchild_handler(int sigchild) {
     sigChildFlag = 1;
+    int savedErrno = errno;
+
+    // wake a fan-out waiting in poll
+    if(sigChildPipe[1] != -1) write(sigChildPipe[1], "c", 1);
     
-    int status;
-    // block until background process is done
-    waitpid(WAIT_ANY, &status, WUNTRACED|WNOHANG); // PUT IN WHILE LOOP !!
+    // reap background jobs only -- foreground & fan-out children are
+    // waited on by putInFG() and fanout()
+    for(int j = 0; j < 256; j++) {
+        if(allJobs[j].isValid || allJobs[j].isFG || allJobs[j].isDone) continue;
+
+        int status;
+        struct rusage usage;
+        if(wait4(allJobs[j].pid, &status, WUNTRACED|WNOHANG, &usage) > 0) {
+            statusReaped(allJobs[j].pid, status, usageCPU(&usage), usage.ru_maxrss);
+        }
+    }
+    publishStatus();
 
+    errno = savedErrno;
 } // gets called for any changed -- use status to find out!!
 
 
@@ -56,6 +280,13 @@ Job addJob(char **args, int wshc, pid_t pid) {
     newJob.numArgs = 0;
     newJob.programName = args[0];
     newJob.pid = pid;
+    newJob.pgid = pid; // every job leads its own process group
+    newJob.isValid = 0;
+    newJob.isStopped = 0;
+    newJob.startTime = time(NULL);
+    newJob.cpuUsec = 0;
+    newJob.maxRSS = 0;
+    newJob.exitStatus = 0;
 
     int i = 1;
     while(args[i] != NULL) { // get args & numArgs
@@ -83,6 +314,7 @@ Job addJob(char **args, int wshc, pid_t pid) {
         }
      }
      
+     publishStatus();
      return newJob;
 }
 
@@ -168,8 +400,13 @@ void putInFG(Job job, int cont) {
       }
     }
 
-    int status;
-    waitpid(foregroundJob.pid, &status, WUNTRACED);
+    publishStatus();
+
+    int status = 0;
+    struct rusage usage;
+    if(wait4(foregroundJob.pid, &status, WUNTRACED, &usage) > 0 && !WIFSTOPPED(status)) {
+        statusReaped(foregroundJob.pid, status, usageCPU(&usage), usage.ru_maxrss);
+    }
 
     // Check if the job was stopped by SIGTSTP
     if (WIFSTOPPED(status) && job.isFG) {
@@ -177,6 +414,9 @@ void putInFG(Job job, int cont) {
         // ADD JOB TO JOB LIST -- help from Omid
         foregroundJob.isValid = 1;
         job.isFG = 0;
+        job.isStopped = 1;
+        sigset_t old;
+        blockSigChild(&old);
         for(int j = 0; j < 256; j++) { // find ID
             if(allJobs[j].isValid == 1) {
                 job.isValid = 0;
@@ -185,10 +425,12 @@ void putInFG(Job job, int cont) {
                 break;
             }
         }
+        restoreSigMask(&old);
     }
 
     // Clear the foreground job
     foregroundJob.isValid = 1;
+    publishStatus();
     
     // return control to the shell
     tcsetpgrp(shellTerminal, shellPGID); // CORRECT -- confirmed by Omid
@@ -220,7 +462,6 @@ void shellInit() {
         signal (SIGTSTP, SIG_IGN);
         signal (SIGTTIN, SIG_IGN);
         signal (SIGTTOU, SIG_IGN);
-        signal (SIGCHLD, SIG_IGN);
         
         // Put ourselves in our own process group -- from piazza
         shellPGID = getpid();
@@ -240,14 +481,48 @@ void shellInit() {
       	tcgetattr (shellTerminal, &shellTmodes);
       
     } // end of isShellInteractive
+
+    // reap background jobs as they finish (not SIG_IGN -- that throws away
+    // the exit status & rusage the status page needs)
+    if(pipe2(sigChildPipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+        char pipeErr[256] = "Couldn't create SIGCHLD pipe\n";
+        write(STDOUT_FILENO, pipeErr, strlen(pipeErr));
+        exit(-1);
+    }
+    signal(SIGCHLD, sigchild_handler);
+}
+
+
+/**
+ * look for command in /usr/bin, then /bin
+ * absolutePath is set to the first executable found
+ *
+ * returns 0 if command was found, -1 otherwise
+ */
+int findPath(char *command, char absolutePath[]) {
+    char pathUsr[256] = "/usr/bin/";
+    char path[256] = "/bin/";
+
+    strcat(pathUsr, command);
+    strcat(path, command);
+    
+    if(access(pathUsr, X_OK) != 0) { // /usr/bin/command not executable
+        if (access(path, X_OK) != 0) { // /bin/command not executable
+            char notExecutable[256] = "Command is not executable\n";
+            write(STDOUT_FILENO, notExecutable, strlen(notExecutable));
+            return -1;
+        } else // reset path to /bin/command
+            strcpy(absolutePath, path);
+    } else // reset path to /usr/bin/command
+        strcpy(absolutePath, pathUsr);
+
+    return 0;
 }
 
 
 // implement commands specified by paths
 int paths(char **args, int wshc) {
 
-    char pathUsr[256] = "/usr/bin/";
-    char path[256] = "/bin/";
     char absolutePath[256] = "";
     args[wshc] = NULL; // null terminate args
 
@@ -262,22 +537,16 @@ int paths(char **args, int wshc) {
         }
     } 
 
-    strcat(pathUsr, args[0]);
-    strcat(path, args[0]);
-    
-    if(access(pathUsr, X_OK) != 0) { // /usr/bin/command not executable
-        if (access(path, X_OK) != 0) { // /bin/command not executable
-            char notExecutable[256] = "Command is not executable\n";
-            write(STDOUT_FILENO, notExecutable, strlen(notExecutable));
-            return -1;
-        } else // reset path to /bin/command
-            strcpy(absolutePath, path);
-    } else // reset path to /usr/bin/command
-        strcpy(absolutePath, pathUsr);
+    if(findPath(args[0], absolutePath) < 0) return -1;
     
+    // hold SIGCHLD until the job is in the list so the handler can find it
+    sigset_t old;
+    blockSigChild(&old);
+
     pid_t pid = fork();
     struct Job job; 
     job = addJob(args, wshc, pid); // ONLY PARENTS SHOULD HAVE ACCESS TO THIS
+    restoreSigMask(&old);
     
     int fg = 1; // default to foreground
     // check if initialized to background
@@ -300,19 +569,21 @@ int paths(char **args, int wshc) {
         launchJob(job, pgid, args, fg, wshc, absolutePath);
         
     } else if (pid > 0) { // parent process !!
+        spawns++;
         if(isShellInteractive) {
             if(!job.pgid) {
                 job.pgid = pid;
             }
             setpgid(pid, job.pgid);
+            for(int j = 0; j < 256; j++) { // bg jobs are already in the list
+                if(!allJobs[j].isValid && allJobs[j].pid == pid) allJobs[j].pgid = job.pgid;
+            }
             
             if(fg) { // job in foreground
                 putInFG(job, 0);
-                foregroundJob = job;
             } else {
-                // wait pid for sigchild -- different waitpid
-        	    signal(SIGCHLD, sigchild_handler);
                 putInBG(job, 0);
+                publishStatus();
             }
         } // end of if(isShellInteractive) 
         
@@ -323,26 +594,443 @@ int paths(char **args, int wshc) {
     }
 
     // remove job from job list & autoremoves from ps
-    if(sigChildFlag) { // get rid of inactive background job
+    if(sigChildFlag) { // get rid of background jobs the handler reaped
+        sigChildFlag = 0;
+        blockSigChild(&old);
         for (int j = 0; j < 256; j++) {
-            if (!allJobs[j].isFG && !allJobs[j].isValid) {
-                // Send SIGCONT to the process group associated with the job
-                if (kill(-allJobs[j].pgid, SIGCONT) < 0) {
-                    char kill[256] = "kill (removing job)\n";
-                    write(STDOUT_FILENO, kill, strlen(kill));
-                    return -1;
-                }
-
+            if (!allJobs[j].isFG && !allJobs[j].isValid && allJobs[j].isDone) {
                 // Clear the job entry
                 allJobs[j].isValid = 1;
                 allJobs[j].id = 0;
             }
         }
+        restoreSigMask(&old);
+        publishStatus();
+    }
+    return 0;
+}
+
+
+// ** FAN-OUT (|+) ** //
+
+#define FANOUT_PIPE_SIZE (1 << 20) // size asked for on every fan-out pipe
+#define FANOUT_ERROR (-2)          // the pump can't go on (poll failed)
+
+// every fd & child of a fan-out, so one cleanup can undo any of it
+typedef struct Fanout {
+    int in[2];		// producer pipe
+    int outRead[256];	// consumer pipes, read ends
+    int out[256];	// consumer pipes, write ends (-1 once a consumer is gone)
+    int numOut;		// consumer pipes opened so far
+    int scratch[2];	// staging pipe for partial tees
+    int devNull;	// 
+    pid_t pids[256];	// producer first, then consumers
+    int numPids;	// children forked so far
+    int isReaped[256];	// 1 once pids[i] has been waited for
+    int producerStatus;	// wait status of the producer
+    int producerReaped;	// 1 once producerStatus is real
+    long cpuUsec;	// user + sys time of every reaped child
+    long maxRSS;	// largest peak RSS of any reaped child
+} Fanout;
+
+
+// close fd if it is open & mark it closed
+void closeFd(int *fd) {
+    if(*fd != -1) close(*fd);
+    *fd = -1;
+}
+
+
+// close every fd the fan-out still has open
+void fanoutClose(Fanout *f) {
+    closeFd(&f->in[0]);
+    closeFd(&f->in[1]);
+    for(int i = 0; i < f->numOut; i++) {
+        closeFd(&f->outRead[i]);
+        closeFd(&f->out[i]);
+    }
+    closeFd(&f->scratch[0]);
+    closeFd(&f->scratch[1]);
+    closeFd(&f->devNull);
+}
+
+
+// reap the children that changed, stopped ones are left alone
+// returns 1 if any child of the fan-out is stopped
+int fanoutReap(Fanout *f, int options) {
+    int stopped = 0;
+    for(int i = 0; i < f->numPids; i++) {
+        if(f->isReaped[i]) continue;
+
+        int status;
+        struct rusage usage;
+        pid_t pid;
+        do {
+            pid = wait4(f->pids[i], &status, options | WUNTRACED, &usage);
+        } while(pid < 0 && errno == EINTR);
+
+        if(pid < 0) { // nothing left to wait for
+            f->isReaped[i] = 1;
+        } else if(pid > 0 && WIFSTOPPED(status)) {
+            stopped = 1;
+        } else if(pid > 0) {
+            // job usage is the whole fan-out: total CPU & the largest RSS
+            f->isReaped[i] = 1;
+            f->cpuUsec += usageCPU(&usage);
+            if(usage.ru_maxrss > f->maxRSS) f->maxRSS = usage.ru_maxrss;
+            if(i == 0) {
+                f->producerStatus = status;
+                f->producerReaped = 1;
+            }
+        }
+    }
+    return stopped;
+}
+
+
+// SIGKILL every child not yet reaped (works on stopped ones too)
+void fanoutKill(Fanout *f) {
+    for(int i = 0; i < f->numPids; i++) {
+        if(!f->isReaped[i]) kill(f->pids[i], SIGKILL);
+    }
+}
+
+
+/**
+ * the shell does the pumping, so fg/bg could never resume a stopped
+ * fan-out -- treat ^Z as a no-op and SIGCONT every child not yet reaped
+ */
+void fanoutContinue(Fanout *f) {
+    char noSuspend[256] = "Fan-out pipelines can't be suspended, continuing\n";
+    write(STDOUT_FILENO, noSuspend, strlen(noSuspend));
+    for(int i = 0; i < f->numPids; i++) {
+        if(!f->isReaped[i]) kill(f->pids[i], SIGCONT);
+    }
+}
+
+
+/**
+ * wait until in has data (or EOF) and out has room (or lost its reader)
+ * either may be -1 to skip it
+ * SIGCHLD wakes the poll through sigChildPipe, so a ^Z on the fan-out is
+ * seen & undone right away
+ *
+ * returns 0 when both are ready, FANOUT_ERROR if poll failed
+ */
+int fanoutWait(Fanout *f, int in, int out) {
+    struct pollfd fds[3] = {
+        {in, POLLIN, 0},
+        {out, POLLOUT, 0},
+        {sigChildPipe[0], POLLIN, 0},
+    };
+
+    while(fds[0].fd != -1 || fds[1].fd != -1) {
+        if(poll(fds, 3, -1) < 0) {
+            if(errno == EINTR) continue;
+            return FANOUT_ERROR; // can't wait -- give up on the fan-out
+        }
+
+        if(fds[2].revents) {
+            char drain[64];
+            while(read(sigChildPipe[0], drain, sizeof(drain)) > 0);
+            if(fanoutReap(f, WNOHANG)) fanoutContinue(f);
+        }
+        if(fds[0].revents) fds[0].fd = -1;
+        if(fds[1].revents) fds[1].fd = -1;
+    }
+    return 0;
+}
+
+
+// non-blocking tee(2) that waits out an empty or full pipe
+// returns bytes copied, -1 on error, FANOUT_ERROR if the pump failed
+ssize_t retryTee(Fanout *f, int in, int out, size_t len) {
+    while(1) {
+        ssize_t copied = tee(in, out, len, SPLICE_F_NONBLOCK);
+        if(copied >= 0) return copied;
+        if(errno == EINTR) continue;
+        if(errno != EAGAIN) return -1;
+        if(fanoutWait(f, in, out) == FANOUT_ERROR) return FANOUT_ERROR;
+    }
+}
+
+
+// non-blocking splice(2) between two pipes that waits out an empty or full pipe
+// returns bytes moved, -1 on error, FANOUT_ERROR if the pump failed
+ssize_t retrySplice(Fanout *f, int in, int out, size_t len) {
+    while(1) {
+        ssize_t moved = splice(in, NULL, out, NULL, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if(moved >= 0) return moved;
+        if(errno == EINTR) continue;
+        if(errno != EAGAIN) return -1;
+        if(fanoutWait(f, in, out) == FANOUT_ERROR) return FANOUT_ERROR;
+    }
+}
+
+
+/**
+ * move len bytes off the head of pipe in and into out
+ * if the reader of out goes away the rest of len is dropped into /dev/null,
+ * so in always ends up len bytes shorter
+ *
+ * returns 0 if out is still alive, -1 if not, FANOUT_ERROR if the pump failed
+ */
+int fanoutSplice(Fanout *f, int in, int out, size_t len) {
+    int alive = 1;
+    while(len > 0) {
+        ssize_t moved = retrySplice(f, in, alive ? out : f->devNull, len);
+        if(moved == FANOUT_ERROR) return FANOUT_ERROR;
+        if(moved <= 0) {
+            if(!alive) break; // even /dev/null failed -- give up on the chunk
+            alive = 0;
+            continue;
+        }
+        len -= moved;
+    }
+    return alive ? 0 : -1;
+}
+
+
+/**
+ * copy len bytes from the head of the producer pipe to out without
+ * consuming them
+ * tee always starts at the head of the pipe, so if out fills up part way
+ * through the chunk, the missing tail is staged in the (empty) scratch pipe
+ *
+ * returns 0 if out got the whole chunk, -1 if its reader went away,
+ * FANOUT_ERROR if the pump failed
+ */
+int fanoutTee(Fanout *f, int out, size_t len) {
+    ssize_t copied = retryTee(f, f->in[0], out, len);
+    if(copied == FANOUT_ERROR) return FANOUT_ERROR;
+    if(copied < 0) return -1;
+    if((size_t)copied == len) return 0;
+
+    // scratch is at least as big as the producer pipe, so this gets the whole chunk
+    ssize_t staged = retryTee(f, f->in[0], f->scratch[1], len);
+    if(staged == FANOUT_ERROR) return FANOUT_ERROR;
+    if(staged < 0 || (size_t)staged != len) {
+        char stageFailed[256] = "Fan-out could not stage chunk\n";
+        write(STDOUT_FILENO, stageFailed, strlen(stageFailed));
+        if(staged > 0) fanoutSplice(f, f->scratch[0], f->devNull, staged);
+        return -1;
+    }
+
+    // out already has the first copied bytes
+    if(fanoutSplice(f, f->scratch[0], f->devNull, copied) == FANOUT_ERROR) return FANOUT_ERROR;
+    return fanoutSplice(f, f->scratch[0], out, len - copied);
+}
+
+
+/**
+ * duplicate everything the producer writes to every consumer, in the kernel
+ * each chunk is tee'd to all consumers but the last, then spliced to the last
+ * one -- a full consumer pipe holds back the producer instead of losing data
+ * a consumer whose reader exits is closed & set to -1
+ *
+ * returns 0 once the producer is done or no consumer is left,
+ * FANOUT_ERROR if the pump can't go on
+ */
+int fanoutPump(Fanout *f) {
+    int alive = f->numOut;
+
+    while(alive > 0) {
+        int last = f->numOut - 1;
+        while(f->out[last] == -1) last--;
+
+        ssize_t chunk = -1;
+        for(int i = 0; i < last; i++) {
+            if(f->out[i] == -1) continue;
+
+            int dead = 0;
+            if(chunk == -1) { // first consumer decides the chunk size
+                ssize_t copied = retryTee(f, f->in[0], f->out[i], FANOUT_PIPE_SIZE);
+                if(copied == FANOUT_ERROR) return FANOUT_ERROR;
+                if(copied == 0) return 0; // producer is done
+                if(copied < 0) dead = 1;
+                else chunk = copied;
+            } else {
+                int result = fanoutTee(f, f->out[i], chunk);
+                if(result == FANOUT_ERROR) return FANOUT_ERROR;
+                dead = result < 0;
+            }
+
+            if(dead) {
+                closeFd(&f->out[i]);
+                alive--;
+            }
+        }
+
+        int dead = 0;
+        if(chunk == -1) { // last consumer is the only one left
+            ssize_t moved = retrySplice(f, f->in[0], f->out[last], FANOUT_PIPE_SIZE);
+            if(moved == FANOUT_ERROR) return FANOUT_ERROR;
+            if(moved == 0) return 0;
+            dead = moved < 0;
+        } else {
+            int result = fanoutSplice(f, f->in[0], f->out[last], chunk);
+            if(result == FANOUT_ERROR) return FANOUT_ERROR;
+            dead = result < 0;
+        }
+
+        if(dead) {
+            closeFd(&f->out[last]);
+            alive--;
+        }
     }
     return 0;
 }
 
 
+/**
+ * runs `<producer> |+ <consumer1> |+ ... |+ <consumerN>` in the foreground
+ * every consumer reads its own copy of the producer's stdout
+ *
+ * returns 1 if command completed, -1 on error
+ */
+int fanout(char **args, int wshc) {
+    char *cmds[256][256];
+    int cmdc[256];
+    char cmdPaths[256][256];
+    int numCmds = 0;
+    args[wshc] = NULL; // null terminate args
+
+    if(strcmp(args[wshc - 1], "&") == 0) {
+        char bgError[256] = "Fan-out pipelines can only run in the foreground\n";
+        write(STDOUT_FILENO, bgError, strlen(bgError));
+        return -1;
+    }
+
+    for(int i = 0; i < wshc; i++) { // | & |+ don't mix
+        if(strcmp(args[i], "|") == 0) {
+            char mixError[256] = "Invalid fan-out pipeline: can't mix | and |+\n";
+            write(STDOUT_FILENO, mixError, strlen(mixError));
+            return -1;
+        }
+    }
+
+    // split args on |+
+    cmdc[0] = 0;
+    for(int i = 0; i <= wshc; i++) {
+        if(i == wshc || strcmp(args[i], "|+") == 0) {
+            if(cmdc[numCmds] == 0) {
+                char syntaxError[256] = "Invalid fan-out pipeline\n";
+                write(STDOUT_FILENO, syntaxError, strlen(syntaxError));
+                return -1;
+            }
+            cmds[numCmds][cmdc[numCmds]] = NULL;
+            if(findPath(cmds[numCmds][0], cmdPaths[numCmds]) < 0) return -1;
+            numCmds++;
+            cmdc[numCmds] = 0;
+        } else {
+            cmds[numCmds][cmdc[numCmds]] = args[i];
+            cmdc[numCmds]++;
+        }
+    }
+
+    Fanout f;
+    f.in[0] = f.in[1] = -1;
+    f.scratch[0] = f.scratch[1] = -1;
+    f.numOut = 0;
+    f.numPids = 0;
+    f.producerStatus = 0;
+    f.producerReaped = 0;
+    f.cpuUsec = 0;
+    f.maxRSS = 0;
+    Job job = {0}; // added once the producer has a pid
+    pid_t pgid = 0;
+    int result = -1;
+    int isBroken = 0;
+
+    f.devNull = open("/dev/null", O_WRONLY);
+    if(f.devNull == -1 || pipe(f.scratch) < 0 || pipe(f.in) < 0) {
+        char pipeFailed[256] = "Failed to create fan-out pipes\n";
+        write(STDOUT_FILENO, pipeFailed, strlen(pipeFailed));
+        goto cleanup;
+    }
+    for(int i = 0; i < numCmds - 1; i++) {
+        int fds[2];
+        if(pipe(fds) < 0) {
+            char pipeFailed[256] = "Failed to create fan-out pipes\n";
+            write(STDOUT_FILENO, pipeFailed, strlen(pipeFailed));
+            goto cleanup;
+        }
+        f.outRead[i] = fds[0];
+        f.out[i] = fds[1];
+        f.numOut++;
+        fcntl(f.out[i], F_SETPIPE_SZ, FANOUT_PIPE_SIZE);
+    }
+    // scratch can never be smaller than the producer pipe (see fanoutTee)
+    fcntl(f.scratch[1], F_SETPIPE_SZ, FANOUT_PIPE_SIZE);
+    fcntl(f.in[1], F_SETPIPE_SZ, fcntl(f.scratch[1], F_GETPIPE_SZ));
+
+    for(int i = 0; i < numCmds; i++) {
+        pid_t pid = fork();
+        if(pid < 0) { // fork failed
+            char forkFail[256] = "Fork Failed\n";
+            write(STDOUT_FILENO, forkFail, strlen(forkFail));
+            goto cleanup;
+        }
+
+        if(pid == 0) { // child process !!
+            if(i == 0) dup2(f.in[1], STDOUT_FILENO);
+            else dup2(f.outRead[i - 1], STDIN_FILENO);
+            fanoutClose(&f);
+
+            launchJob(job, pgid, cmds[i], 1, cmdc[i], cmdPaths[i]);
+        }
+
+        // parent process !!
+        spawns++;
+        f.pids[f.numPids] = pid;
+        f.isReaped[f.numPids] = 0;
+        f.numPids++;
+        if(!pgid) {
+            pgid = pid; // whole fan-out shares the producer's group
+            job = addJob(args, wshc, pid);
+        }
+        if(isShellInteractive) setpgid(pid, pgid);
+    }
+
+    // the shell only keeps the ends it pumps between
+    closeFd(&f.in[1]);
+    for(int i = 0; i < f.numOut; i++) closeFd(&f.outRead[i]);
+
+    publishStatus();
+    if(isShellInteractive) tcsetpgrp(shellTerminal, pgid);
+
+    signal(SIGPIPE, SIG_IGN); // exited consumers show up as EPIPE instead
+    isBroken = fanoutPump(&f) == FANOUT_ERROR;
+    signal(SIGPIPE, SIG_DFL);
+    result = 1;
+
+cleanup:
+    // a fork failed part way or the pump broke -- take down whatever did start
+    if(isBroken) {
+        char pumpFailed[256] = "Fan-out pump failed, killed it\n";
+        write(STDOUT_FILENO, pumpFailed, strlen(pumpFailed));
+        result = -1;
+    }
+    if(result < 0) fanoutKill(&f);
+
+    // closing the producer pipe lets the producer see SIGPIPE if no one is left
+    fanoutClose(&f);
+
+    // consumers may still be draining -- a ^Z now is undone like in the pump
+    while(fanoutReap(&f, 0)) fanoutContinue(&f);
+    if(f.producerReaped) statusReaped(f.pids[0], f.producerStatus, f.cpuUsec, f.maxRSS);
+
+    if(f.numPids > 0) {
+        // Clear the foreground job
+        foregroundJob.isValid = 1;
+        publishStatus();
+        if(isShellInteractive) tcsetpgrp(shellTerminal, shellPGID);
+    }
+
+    return result;
+}
+
+
 // ** BUILT IN COMMANDS ** //
 
 
@@ -396,7 +1084,12 @@ int bg(char **args, int wshc) {
             }
 
             // Update job status
+            sigset_t old;
+            blockSigChild(&old);
             allJobs[i].isDone = 0;
+            allJobs[i].isStopped = 0;
+            restoreSigMask(&old);
+            publishStatus();
 
             found = 1;
             break;
@@ -454,9 +1147,12 @@ int fg(char **args, int wshc) {
     // find job associated with id
     for(int i = 0; i < 256; i++) {
         if (!allJobs[i].isValid && allJobs[i].id == jobID) {
+            sigset_t old;
+            blockSigChild(&old);
             allJobs[i].isFG = 1;
             foregroundJob = allJobs[i];
             allJobs[i].isValid = 1;
+            restoreSigMask(&old);
             putInFG(allJobs[i], 1);
         }
     }
@@ -563,6 +1259,9 @@ int main(int argc, char *argv[]) {
     // initialize jobs to be free
     for(int i = 0; i < 256; i++) allJobs[i].isValid = 1;
 
+    // publish job table for external monitoring
+    statusInit();
+
     // check if interactive mode or batch mode
     if (argc == 1) { // interactive mode
         isInteractive = 1;
@@ -612,6 +1311,7 @@ int main(int argc, char *argv[]) {
 
         // piping
         isPipe = 0;
+        int isFanout = 0;
         int pipeIndex = -1;
 
         // get number of arguments -- chatgpt for help with logic of string of strings
@@ -623,16 +1323,25 @@ int main(int argc, char *argv[]) {
                 if(strcmp(seperate, "|") == 0) { // it is a pipe
                     isPipe = 1;
                     pipeIndex = wshc;
+                } else if(strcmp(seperate, "|+") == 0) { // fan-out
+                    isFanout = 1;
                 }
                 args[wshc] = strdup(seperate);
                 wshc++;
             }
         }
 
-        if(!isPipe) { // (assumming there is only |)
+        commandsRun++;
+
+        if(isFanout) { // producer |+ consumer |+ ...
+            fanout(args, wshc);
+        } else if(!isPipe) { // (assumming there is only |)
 
             // built in commands: exit, cd, jobs, fg, & bg
-            if (builtInCommands(args, wshc)) continue;
+            if (builtInCommands(args, wshc)) {
+                publishStatus();
+                continue;
+            }
 
             // paths
             paths(args, wshc);
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "wshstat.h"
+
+// wshstat -- dump the job table wsh publishes in its status page //
+// usage: ./wshstat [pid]   (no pid dumps every running shell in the status dir)
+
+
+/**
+ * copy a consistent snapshot of page into snap without ever blocking the shell
+ * retry while the shell is mid-update (odd seq) or updated during the copy
+ *
+ * returns 0 on success, -1 if no stable copy was seen
+ */
+int readPage(const StatPage *page, StatPage *snap) {
+    for(int tries = 0; tries < 1000; tries++) {
+        uint64_t before = atomic_load_explicit(&page->seq, memory_order_acquire);
+        if(before & 1) {
+            sched_yield();
+            continue;
+        }
+
+        memcpy(snap, (const void *)page, sizeof(StatPage));
+        atomic_thread_fence(memory_order_acquire);
+
+        if(atomic_load_explicit(&page->seq, memory_order_relaxed) == before) return 0;
+    }
+    return -1;
+}
+
+
+void printJob(StatJob *job) {
+    char *states[4] = {"fg", "bg", "stopped", "done"};
+    char *state = job->state >= 0 && job->state < 4 ? states[job->state] : "?";
+
+    char start[16];
+    time_t startTime = job->startTime;
+    strftime(start, sizeof(start), "%H:%M:%S", localtime(&startTime));
+
+    printf("%-4d %-8s %-8d %-8d %-9s %-9lld %-9lld %s\n", job->id, state, job->pid,
+        job->pgid, start, (long long)job->cpuUsec / 1000, (long long)job->maxRSS, job->cmd);
+}
+
+
+/**
+ * print one status page
+ * skipGone leaves out pages of shells that are no longer running,
+ * separate puts a blank line before the page
+ *
+ * returns 0 if the page was printed, -1 otherwise
+ */
+int dump(char *path, int skipGone, int separate) {
+    int fd = open(path, O_RDONLY | O_NOFOLLOW);
+    if(fd == -1) {
+        printf("Failed to open %s\n", path);
+        return -1;
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) < 0 || info.st_size < (off_t)sizeof(StatPage)) {
+        printf("%s is not a status page\n", path);
+        close(fd);
+        return -1;
+    }
+
+    StatPage *page = mmap(NULL, sizeof(StatPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(page == MAP_FAILED) {
+        printf("Failed to map %s\n", path);
+        return -1;
+    }
+
+    StatPage *snap = malloc(sizeof(StatPage));
+    int failed = snap == NULL || readPage(page, snap) < 0;
+    munmap(page, sizeof(StatPage));
+    if(failed || snap->magic != STAT_MAGIC || snap->version != STAT_VERSION) {
+        printf("%s: no consistent status page\n", path);
+        free(snap);
+        return -1;
+    }
+
+    // a shell killed by SIGKILL leaves its page behind, and its pid may
+    // since belong to something else -- match the start time too
+    int running = statProcStart(snap->shellPid) == snap->procStart;
+    if(!running && skipGone) {
+        free(snap);
+        return -1;
+    }
+    long long uptime = (long long)time(NULL) - snap->startTime;
+    double spawnRate = uptime > 0 ? (double)snap->spawns / uptime : (double)snap->spawns;
+
+    if(separate) printf("\n");
+    printf("wsh %d (%s)  up %llds  commands %lld  spawns %lld (%.2f/s)  queue %d\n",
+        snap->shellPid, running ? "running" : "gone", uptime,
+        (long long)snap->commandsRun, (long long)snap->spawns, spawnRate, snap->queueDepth);
+    printf("%-4s %-8s %-8s %-8s %-9s %-9s %-9s %s\n",
+        "ID", "STATE", "PID", "PGID", "START", "CPU(ms)", "RSS(KB)", "COMMAND");
+
+    int numJobs = snap->numJobs < STAT_MAX_JOBS ? snap->numJobs : STAT_MAX_JOBS;
+    for(int i = 0; i < numJobs; i++) printJob(&snap->jobs[i]);
+
+    if(snap->hasLast) {
+        printf("last reaped:\n");
+        printJob(&snap->last);
+    }
+
+    free(snap);
+    return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+    char dir[256];
+    char path[512];
+    statDir(dir, sizeof(dir));
+    if(statDirIsPrivate(dir) < 0) {
+        printf("No private status directory at %s\n", dir);
+        return -1;
+    }
+
+    if(argc == 2) { // one shell
+        snprintf(path, sizeof(path), "%s/%s.stat", dir, argv[1]);
+        return dump(path, 0, 0) < 0 ? -1 : 0;
+    } else if(argc != 1) {
+        printf("usage: wshstat [pid]\n");
+        return -1;
+    }
+
+    // every running shell
+    DIR *stats = opendir(dir);
+    if(stats == NULL) {
+        printf("No status pages in %s\n", dir);
+        return -1;
+    }
+
+    struct dirent *entry;
+    int found = 0;
+    while((entry = readdir(stats)) != NULL) {
+        char *ext = strrchr(entry->d_name, '.');
+        if(ext == NULL || strcmp(ext, ".stat") != 0) continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if(dump(path, 1, found) == 0) found = 1;
+    }
+    closedir(stats);
+
+    if(!found) printf("No status pages in %s\n", dir);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef WSHSTAT_H
+#define WSHSTAT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// shared-memory status page that wsh publishes its job table into //
+
+#define STAT_MAGIC   0x54534857 // "WHST"
+#define STAT_VERSION 2
+#define STAT_MAX_JOBS 256
+#define STAT_CMD_LEN  256
+
+// job states
+#define STAT_FG      0 // running in the foreground
+#define STAT_BG      1 // running in the background
+#define STAT_STOPPED 2 // stopped by SIGTSTP
+#define STAT_DONE    3 // reaped, still in the job list
+
+typedef struct StatJob {
+    int32_t id;             // job id, 0 for the foreground job
+    int32_t state;          // one of STAT_*
+    int32_t pid;            //
+    int32_t pgid;           //
+    int64_t startTime;      // seconds since the epoch
+    int64_t cpuUsec;        // user + sys time, filled in when reaped
+    int64_t maxRSS;         // peak resident set in KB, filled in when reaped
+    int32_t exitStatus;     // raw wait status, filled in when reaped
+    char cmd[STAT_CMD_LEN]; // `<program name> <arg1> ... <argN>`
+} StatJob;
+
+/**
+ * the shell makes seq odd while it rewrites the page and even again when done
+ * a reader copies the page & retries if seq was odd or changed under it,
+ * so readers never block the shell
+ */
+typedef struct StatPage {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic uint64_t seq;
+    int32_t shellPid;
+    int32_t numJobs;        // entries used in jobs
+    int64_t startTime;      // when the shell started, seconds since the epoch
+    int64_t procStart;      // shell's start time from /proc (see statProcStart)
+    int64_t commandsRun;    // every non-empty line, built ins included
+    int64_t spawns;         // processes forked (spawns/sec = spawns / uptime)
+    int32_t queueDepth;     // background & stopped jobs not yet reaped
+    int32_t hasLast;        // 1 once last is filled in
+    StatJob last;           // most recently reaped job
+    StatJob jobs[STAT_MAX_JOBS];
+} StatPage;
+
+
+// directory status pages live in: $XDG_RUNTIME_DIR/wsh, else /tmp/wsh-<uid>
+static inline void statDir(char dir[], size_t len) {
+    char *runtime = getenv("XDG_RUNTIME_DIR");
+    if(runtime != NULL && runtime[0] != '\0')
+        snprintf(dir, len, "%s/wsh", runtime);
+    else
+        snprintf(dir, len, "/tmp/wsh-%d", (int)getuid());
+}
+
+
+/**
+ * the dir may sit in /tmp, where anyone could have made it first
+ * only trust a real directory (not a symlink) that we own with mode 0700
+ *
+ * returns 0 if dir is private, -1 otherwise
+ */
+static inline int statDirIsPrivate(const char *dir) {
+    struct stat info;
+    if(lstat(dir, &info) < 0) return -1;
+    if(!S_ISDIR(info.st_mode) || info.st_uid != getuid()) return -1;
+    if((info.st_mode & 0777) != S_IRWXU) return -1;
+    return 0;
+}
+
+
+/**
+ * start time of pid in clock ticks since boot (field 22 of /proc/<pid>/stat)
+ * a pid gets reused, a pid & its start time don't
+ *
+ * returns -1 if pid isn't running (zombies included)
+ */
+static inline long long statProcStart(int pid) {
+    char path[64];
+    char buf[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *file = fopen(path, "r");
+    if(file == NULL) return -1;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, file);
+    fclose(file);
+    buf[len] = '\0';
+
+    char *field = strrchr(buf, ')'); // end of field 2 -- comm can hold spaces
+    if(field == NULL || field[1] == '\0' || field[2] == 'Z' || field[2] == 'X') return -1;
+    for(int i = 2; i < 22 && field != NULL; i++) field = strchr(field + 1, ' ');
+    return field == NULL ? -1 : atoll(field + 1);
+}
+
+#endif